@@ -0,0 +1,171 @@
+#include "streaming_upload_arena.hpp"
+
+#include <stdexcept>
+
+#include <GLFW/glfw3.h>
+
+#include "sbpt_generated_includes.hpp"
+
+// the glad loader only exposes gl 3.3 with no extensions, so buffer storage is detected and loaded at runtime instead
+// of relying on glad having been generated with it
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void(APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+/// returns nullptr if the current context doesn't support buffer storage
+static BufferStorageProc load_buffer_storage() {
+    GLint major_version = 0, minor_version = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major_version);
+    glGetIntegerv(GL_MINOR_VERSION, &minor_version);
+
+    bool core_in_context = major_version > 4 || (major_version == 4 && minor_version >= 4);
+    if (!core_in_context && !glfwExtensionSupported("GL_ARB_buffer_storage"))
+        return nullptr;
+
+    return reinterpret_cast<BufferStorageProc>(glfwGetProcAddress("glBufferStorage"));
+}
+
+StreamingUploadArena::StreamingUploadArena(GLsizeiptr bytes_per_frame, unsigned int frames_in_flight)
+    : bytes_per_frame(bytes_per_frame), frames_in_flight(frames_in_flight) {
+    if (bytes_per_frame <= 0 || frames_in_flight == 0) {
+        throw std::invalid_argument("streaming upload arena needs a positive size and at least one frame in flight");
+    }
+
+    region_fences.assign(frames_in_flight, nullptr);
+    GLsizeiptr total_size = bytes_per_frame * frames_in_flight;
+
+    // the copy write target is used so that creating and mapping the buffer doesn't disturb the array buffer binding
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    BufferStorageProc buffer_storage = load_buffer_storage();
+    if (buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        buffer_storage(GL_COPY_WRITE_BUFFER, total_size, nullptr, flags);
+        mapped_data = static_cast<char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total_size, flags));
+        if (mapped_data == nullptr) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &buffer);
+            throw std::runtime_error("couldn't persistently map the streaming upload buffer");
+        }
+        mapped_offset = 0;
+        persistently_mapped = true;
+    }
+
+    if (!persistently_mapped) {
+        glBufferData(GL_COPY_WRITE_BUFFER, total_size, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+StreamingUploadArena::~StreamingUploadArena() {
+    if (mapped_data) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    for (GLsync fence : region_fences) {
+        if (fence)
+            glDeleteSync(fence);
+    }
+
+    glDeleteBuffers(1, &buffer);
+}
+
+void StreamingUploadArena::wait_for_current_region() {
+    GLsync fence = region_fences[current_region];
+    if (!fence)
+        return;
+
+    const GLuint64 one_millisecond_ns = 1'000'000;
+    while (true) {
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, one_millisecond_ns);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+            break;
+        if (result == GL_WAIT_FAILED) {
+            global_logger->warn("waiting on a streaming upload region fence failed, reusing the region anyway");
+            break;
+        }
+    }
+
+    glDeleteSync(fence);
+    region_fences[current_region] = nullptr;
+}
+
+void StreamingUploadArena::begin_frame() { wait_for_current_region(); }
+
+void StreamingUploadArena::end_frame() {
+    flush();
+
+    // only possible if nothing waited on the region this frame, the new fence covers everything the old one did
+    if (region_fences[current_region])
+        glDeleteSync(region_fences[current_region]);
+
+    region_fences[current_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    current_region = (current_region + 1) % frames_in_flight;
+    cursor = 0;
+}
+
+std::optional<StreamingAllocation> StreamingUploadArena::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    if (size <= 0) {
+        throw std::invalid_argument("streaming upload allocations must have a positive size");
+    }
+    if (alignment <= 0 || (alignment & (alignment - 1)) != 0) {
+        throw std::invalid_argument("streaming upload alignment must be a power of two");
+    }
+
+    wait_for_current_region();
+
+    // align the absolute offset rather than the cursor so that alignment holds for whatever binds the buffer
+    GLintptr region_start = current_region_offset();
+    GLintptr region_end = region_start + bytes_per_frame;
+    GLintptr offset = (region_start + cursor + alignment - 1) & ~(alignment - 1);
+
+    if (offset + size > region_end)
+        return std::nullopt;
+
+    if (!persistently_mapped && !mapped_data) {
+        if (!map_rest_of_current_region(offset))
+            return std::nullopt;
+    }
+
+    cursor = offset + size - region_start;
+    return StreamingAllocation{mapped_data + (offset - mapped_offset), buffer, offset, size};
+}
+
+void StreamingUploadArena::flush() {
+    if (persistently_mapped || !mapped_data)
+        return;
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    mapped_data = nullptr;
+}
+
+bool StreamingUploadArena::map_rest_of_current_region(GLintptr from_offset) {
+    GLintptr region_end = current_region_offset() + bytes_per_frame;
+
+    // unsynchronized is safe because the region's fence has already been waited on, and nothing earlier in this
+    // frame overlaps the range since the cursor only moves forward
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    mapped_data =
+        static_cast<char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, from_offset, region_end - from_offset, flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (mapped_data == nullptr) {
+        global_logger->warn("couldn't map the streaming upload buffer");
+        return false;
+    }
+
+    mapped_offset = from_offset;
+    return true;
+}
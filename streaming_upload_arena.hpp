@@ -0,0 +1,80 @@
+#ifndef STREAMING_UPLOAD_ARENA_HPP
+#define STREAMING_UPLOAD_ARENA_HPP
+
+#include <glad/glad.h>
+
+#include <optional>
+#include <vector>
+
+/// a piece of the arena's buffer that the caller can write into directly and then source from with the returned
+/// buffer and offset, eg) glBindVertexBuffer or glVertexAttribPointer with offset as the pointer argument
+struct StreamingAllocation {
+    void *data;
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+};
+
+/*
+ * @brief a ring buffer of gpu memory for data that is rewritten every frame
+ *
+ * @note the buffer is split into frames_in_flight regions, each frame bump allocates out of one region. at the end of
+ * the frame that region is fenced and the next one is used, a region is only handed out again once the gpu has
+ * signalled its fence, so writing into it never races with draws that are still reading it and the driver never has
+ * to orphan or copy anything.
+ *
+ * @note when the context supports ARB_buffer_storage (or is gl 4.4+) the whole buffer is persistently and coherently mapped once
+ * and allocations are just pointers into it. otherwise the remaining part of the current region is mapped with
+ * glMapBufferRange on demand, and because a mapped buffer can't be used by draw calls you have to call flush before
+ * drawing with anything you allocated, which invalidates the data pointers of every allocation made so far. calling
+ * flush when the buffer is persistently mapped does nothing so it's safe to always call it.
+ *
+ * @note regions are only recycled by end_frame, if it never gets called the first region fills up and every allocate
+ * after that returns nullopt. the window calls begin_frame and end_frame for you in start_of_tick_glfw_logic and
+ * end_of_tick_glfw_logic, if you swap buffers yourself you have to call them yourself.
+ */
+class StreamingUploadArena {
+  public:
+    StreamingUploadArena(GLsizeiptr bytes_per_frame, unsigned int frames_in_flight = 3);
+    ~StreamingUploadArena();
+
+    StreamingUploadArena(const StreamingUploadArena &) = delete;
+    StreamingUploadArena &operator=(const StreamingUploadArena &) = delete;
+
+    /// waits until the gpu is done with the region this frame will write into
+    void begin_frame();
+    /// unmaps and fences the current region then moves on to the next one, call this after the frame's draws are
+    /// issued and before swapping buffers
+    void end_frame();
+
+    /// returns nullopt if there isn't enough space left in this frame's region
+    /// @param alignment must be a power of two
+    std::optional<StreamingAllocation> allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+    void flush();
+
+    GLuint get_buffer() const { return buffer; }
+    GLsizeiptr get_bytes_per_frame() const { return bytes_per_frame; }
+    GLsizeiptr get_bytes_used_this_frame() const { return cursor; }
+    bool is_persistently_mapped() const { return persistently_mapped; }
+
+  private:
+    GLsizeiptr bytes_per_frame;
+    unsigned int frames_in_flight;
+    GLuint buffer = 0;
+
+    bool persistently_mapped = false;
+    // in the persistent case this is the whole buffer, otherwise it is the currently mapped part of the region
+    char *mapped_data = nullptr;
+    GLintptr mapped_offset = 0;
+
+    std::vector<GLsync> region_fences;
+    unsigned int current_region = 0;
+    // bytes handed out so far in the current region
+    GLsizeiptr cursor = 0;
+
+    GLintptr current_region_offset() const { return static_cast<GLintptr>(current_region) * bytes_per_frame; }
+    void wait_for_current_region();
+    bool map_rest_of_current_region(GLintptr from_offset);
+};
+
+#endif // STREAMING_UPLOAD_ARENA_HPP
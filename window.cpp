@@ -97,6 +97,10 @@ Window::Window(unsigned int width_px, unsigned int height_px, const std::string
 // the window manges the glfw lifetime, also since we initialize window first before operating with opengl it is
 // destructed last so that all other operations will not fail during program close
 Window::~Window() {
+    telemetry.reset();
+    // the arena owns gl objects so it has to go before the context does
+    streaming_upload_arena.reset();
+
     if (glfw_window)
         glfwDestroyWindow(glfw_window);
 
@@ -312,6 +316,8 @@ void Window::toggle_fullscreen() {
     }
 
     window_in_fullscreen = !window_in_fullscreen; // Toggle fullscreen state
+    if (telemetry)
+        sample_telemetry_window_size();
 }
 
 void Window::enable_fullscreen() {
@@ -325,6 +331,8 @@ void Window::enable_fullscreen() {
 
     glfwSetWindowMonitor(glfw_window, monitor, 0, 0, width_px, height_px, mode->refreshRate);
     window_in_fullscreen = true;
+    if (telemetry)
+        sample_telemetry_window_size();
 }
 
 void Window::disable_fullscreen() {
@@ -339,6 +347,8 @@ void Window::disable_fullscreen() {
                          height_px, 0);
 
     window_in_fullscreen = false; // Toggle fullscreen state
+    if (telemetry)
+        sample_telemetry_window_size();
 }
 
 #include <sstream>
@@ -500,6 +510,8 @@ void Window::set_resolution(const std::string &resolution) {
         width_px = width;
         height_px = height;
         glfwSetWindowSize(glfw_window, width, height);
+        if (telemetry)
+            sample_telemetry_window_size();
     } else {
         throw std::invalid_argument("Input string is not in the correct format (e.g. 1280x960)");
     }
@@ -526,3 +538,73 @@ void Window::set_fullscreen_by_on_off(const std::string &on_off_string) {
         std::cout << "Invalid value for fullscreen: {}" << on_off_string << std::endl;
     }
 }
+
+bool Window::enable_telemetry(const std::string &shared_memory_name) {
+    // our own segment would look like it's in use by a live process, so re-enabling it just keeps publishing
+    if (telemetry && telemetry->get_shared_memory_name() ==
+                         WindowTelemetry::normalize_shared_memory_name(shared_memory_name)) {
+        return true;
+    }
+
+    GLFWmonitor *monitor = get_monitor_window_is_currently_on();
+    const GLFWvidmode *mode = glfwGetVideoMode(monitor);
+    int refresh_rate_hz = mode ? mode->refreshRate : 0;
+
+    // built on the side so that a failure leaves any telemetry that is already running untouched
+    std::unique_ptr<WindowTelemetry> new_telemetry;
+    try {
+        new_telemetry = std::make_unique<WindowTelemetry>(shared_memory_name, refresh_rate_hz);
+    } catch (const std::runtime_error &e) {
+        global_logger->warn("couldn't enable window telemetry: {}", e.what());
+        return false;
+    }
+    telemetry = std::move(new_telemetry);
+
+    sample_telemetry_window_size();
+    global_logger->info("publishing window telemetry to shared memory: {}", telemetry->get_shared_memory_name());
+    return true;
+}
+
+void Window::disable_telemetry() { telemetry.reset(); }
+
+void Window::sample_telemetry_window_size() {
+    int window_width, window_height, framebuffer_width, framebuffer_height;
+    glfwGetWindowSize(glfw_window, &window_width, &window_height);
+    glfwGetFramebufferSize(glfw_window, &framebuffer_width, &framebuffer_height);
+
+    telemetry_window_state.window_width_px = static_cast<uint32_t>(window_width);
+    telemetry_window_state.window_height_px = static_cast<uint32_t>(window_height);
+    telemetry_window_state.framebuffer_width_px = static_cast<uint32_t>(framebuffer_width);
+    telemetry_window_state.framebuffer_height_px = static_cast<uint32_t>(framebuffer_height);
+    frames_since_telemetry_size_sample = 0;
+}
+
+void Window::record_telemetry(double swap_duration_ms, double poll_duration_ms) {
+    if (++frames_since_telemetry_size_sample >= telemetry_size_sample_interval) {
+        sample_telemetry_window_size();
+    }
+
+    // glfw keeps track of the monitor itself so this doesn't talk to the display server
+    telemetry_window_state.window_in_fullscreen = glfwGetWindowMonitor(glfw_window) != nullptr;
+    telemetry_window_state.cursor_is_disabled = cursor_is_disabled;
+
+    telemetry->record_frame(swap_duration_ms, poll_duration_ms, telemetry_window_state);
+}
+
+bool Window::enable_streaming_upload_arena(GLsizeiptr bytes_per_frame, unsigned int frames_in_flight) {
+    // built on the side so that a failure leaves any arena that is already running untouched
+    std::unique_ptr<StreamingUploadArena> new_streaming_upload_arena;
+    try {
+        new_streaming_upload_arena = std::make_unique<StreamingUploadArena>(bytes_per_frame, frames_in_flight);
+    } catch (const std::exception &e) {
+        global_logger->warn("couldn't enable streaming upload arena: {}", e.what());
+        return false;
+    }
+    streaming_upload_arena = std::move(new_streaming_upload_arena);
+
+    global_logger->info("created streaming upload arena with {} bytes per frame over {} frames, persistently mapped: {}",
+                        bytes_per_frame, frames_in_flight, streaming_upload_arena->is_persistently_mapped());
+    return true;
+}
+
+void Window::disable_streaming_upload_arena() { streaming_upload_arena.reset(); }
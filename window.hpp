@@ -4,12 +4,16 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <chrono>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <ostream>
 #include <vector>
 
 #include "sbpt_generated_includes.hpp"
+#include "streaming_upload_arena.hpp"
+#include "window_telemetry.hpp"
 
 struct VideoMode {
     int width;
@@ -92,6 +96,40 @@ class Window {
     void disable_fullscreen();
     void set_fullscreen_by_on_off(const std::string &on_off_string);
 
+    /*
+     * @brief start publishing per frame stats into a named shared memory segment
+     *
+     * @note an external process can open the segment with WindowTelemetryReader and read it at any rate without
+     * blocking the render loop, the stats are updated at the end of every tick.
+     *
+     * @note enabling it again under the name it is already publishing to does nothing, enabling it under a different
+     * name moves publishing over to the new segment
+     *
+     * @return false if the segment couldn't be created, in which case whatever telemetry was running before keeps
+     * running
+     */
+    bool enable_telemetry(const std::string &shared_memory_name);
+    void disable_telemetry();
+
+    /*
+     * @brief create a window owned StreamingUploadArena that is tied to the tick lifecycle
+     *
+     * @note once enabled, start_of_tick_glfw_logic waits for the gpu to be done with the region the tick will write
+     * into and end_of_tick_glfw_logic fences it before swapping, so callers only ever need to allocate and write. this
+     * means the main loop has to go through wrap_tick_with_required_glfw_calls (or call those two functions), a loop
+     * that calls glfwSwapBuffers directly never recycles a region and has to call begin_frame and end_frame itself.
+     *
+     * @note enabling it again replaces the current arena, so just like disable_streaming_upload_arena it invalidates
+     * any pointer from get_streaming_upload_arena and every allocation made from the old arena.
+     *
+     * @return false if the arena couldn't be created, including when the arguments are invalid, in which case the
+     * current arena (if any) is left as it was
+     */
+    bool enable_streaming_upload_arena(GLsizeiptr bytes_per_frame, unsigned int frames_in_flight = 3);
+    void disable_streaming_upload_arena();
+    /// nullptr if the arena hasn't been enabled, the pointer is only valid until the arena is disabled or re-enabled
+    StreamingUploadArena *get_streaming_upload_arena() { return streaming_upload_arena.get(); }
+
     std::tuple<unsigned int, unsigned int> reduce_ratio(std::tuple<unsigned int, unsigned int> ratio) {
         auto [num, den] = ratio;
         if (den == 0) {
@@ -114,21 +152,42 @@ class Window {
             // NOTE: in the future the user can specify what they want to clear.
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         }
+        if (streaming_upload_arena) {
+            LogSection _(*global_logger, "wait for streaming upload region", LogSection::LogMode::disable);
+            streaming_upload_arena->begin_frame();
+        }
     }
 
     void end_of_tick_glfw_logic() {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point swap_start, swap_end, poll_start, poll_end;
+
+        // fence before the swap so that the fence covers every draw made this tick
+        if (streaming_upload_arena) {
+            streaming_upload_arena->end_frame();
+        }
+
         {
             LogSection _(*global_logger, "gl swap buffer and poll events", LogSection::LogMode::disable);
             // swap and poll after tick
             {
                 LogSection _(*global_logger, "swap buffers");
+                swap_start = Clock::now();
                 glfwSwapBuffers(glfw_window);
+                swap_end = Clock::now();
             }
             {
                 LogSection _(*global_logger, "poll events");
+                poll_start = Clock::now();
                 glfwPollEvents();
+                poll_end = Clock::now();
             }
         }
+
+        if (telemetry) {
+            record_telemetry(std::chrono::duration<double, std::milli>(swap_end - swap_start).count(),
+                             std::chrono::duration<double, std::milli>(poll_end - poll_start).count());
+        }
     }
 
     std::function<void(double)> wrap_tick_with_required_glfw_calls(std::function<void(double)> tick) {
@@ -141,6 +200,18 @@ class Window {
 
     bool cursor_is_disabled = false;
     bool window_in_fullscreen = false;
+
+  private:
+    std::unique_ptr<WindowTelemetry> telemetry;
+    // querying the window and framebuffer size is a round trip to the display server on x11, so the sizes are cached
+    // and only resampled every telemetry_size_sample_interval frames or when the window itself changes size
+    static constexpr unsigned int telemetry_size_sample_interval = 60;
+    unsigned int frames_since_telemetry_size_sample = 0;
+    WindowTelemetryWindowState telemetry_window_state{};
+    void sample_telemetry_window_size();
+    void record_telemetry(double swap_duration_ms, double poll_duration_ms);
+
+    std::unique_ptr<StreamingUploadArena> streaming_upload_arena;
 };
 
 #endif // WINDOW_HPP
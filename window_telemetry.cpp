@@ -0,0 +1,239 @@
+#include "window_telemetry.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::string WindowTelemetry::normalize_shared_memory_name(const std::string &name) {
+    if (!name.empty() && name.front() == '/')
+        return name;
+    return "/" + name;
+}
+
+#ifndef _WIN32
+
+static bool segment_is_big_enough(int file_descriptor) {
+    struct stat segment_stat;
+    if (fstat(file_descriptor, &segment_stat) == -1)
+        return false;
+    return static_cast<std::size_t>(segment_stat.st_size) >= sizeof(WindowTelemetryBlock);
+}
+
+static bool process_is_alive(int64_t pid) {
+    if (pid <= 0)
+        return false;
+    // EPERM means it exists but belongs to someone else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+}
+
+/// a segment is only stale if it holds a fully set up block whose creator has exited, an undersized segment or one
+/// without the magic yet may belong to a writer that is still starting up so it counts as in use
+static bool segment_is_stale(const std::string &name) {
+    int file_descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (file_descriptor == -1)
+        return false;
+
+    bool stale = false;
+    if (segment_is_big_enough(file_descriptor)) {
+        void *mapping = mmap(nullptr, sizeof(WindowTelemetryBlock), PROT_READ, MAP_SHARED, file_descriptor, 0);
+        if (mapping != MAP_FAILED) {
+            const auto *existing_block = static_cast<const WindowTelemetryBlock *>(mapping);
+            stale = existing_block->magic.load(std::memory_order_acquire) == window_telemetry_magic &&
+                    !process_is_alive(existing_block->owner_pid);
+            munmap(mapping, sizeof(WindowTelemetryBlock));
+        }
+    }
+
+    close(file_descriptor);
+    return stale;
+}
+
+WindowTelemetry::WindowTelemetry(const std::string &shared_memory_name, int refresh_rate_hz)
+    : shared_memory_name(normalize_shared_memory_name(shared_memory_name)) {
+
+    // exclusive so that we never take over a block another window is writing to
+    file_descriptor = shm_open(this->shared_memory_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (file_descriptor == -1 && errno == EEXIST) {
+        if (!segment_is_stale(this->shared_memory_name)) {
+            throw std::runtime_error("telemetry shared memory is in use: " +
+                                     this->shared_memory_name);
+        }
+        shm_unlink(this->shared_memory_name.c_str());
+        file_descriptor = shm_open(this->shared_memory_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (file_descriptor == -1) {
+        throw std::runtime_error("couldn't open telemetry shared memory: " + this->shared_memory_name);
+    }
+
+    if (ftruncate(file_descriptor, sizeof(WindowTelemetryBlock)) == -1) {
+        close(file_descriptor);
+        shm_unlink(this->shared_memory_name.c_str());
+        throw std::runtime_error("couldn't size telemetry shared memory: " + this->shared_memory_name);
+    }
+
+    void *mapping = mmap(nullptr, sizeof(WindowTelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close(file_descriptor);
+        shm_unlink(this->shared_memory_name.c_str());
+        throw std::runtime_error("couldn't map telemetry shared memory: " + this->shared_memory_name);
+    }
+
+    block = new (mapping) WindowTelemetryBlock();
+    block->owner_pid = getpid();
+    block->version = window_telemetry_version;
+    block->sequence.store(0, std::memory_order_relaxed);
+
+    if (refresh_rate_hz > 0) {
+        snapshot.target_frame_time_ms = 1000.0 / refresh_rate_hz;
+    }
+
+    publish();
+    block->magic.store(window_telemetry_magic, std::memory_order_release);
+}
+
+WindowTelemetry::~WindowTelemetry() {
+    if (block)
+        munmap(block, sizeof(WindowTelemetryBlock));
+    if (file_descriptor != -1)
+        close(file_descriptor);
+    // readers that already have it mapped keep their mapping, new readers will no longer find it
+    shm_unlink(shared_memory_name.c_str());
+}
+
+WindowTelemetryReader::WindowTelemetryReader(const std::string &shared_memory_name) {
+    std::string name = WindowTelemetry::normalize_shared_memory_name(shared_memory_name);
+
+    file_descriptor = shm_open(name.c_str(), O_RDONLY, 0);
+    if (file_descriptor == -1) {
+        throw std::runtime_error("couldn't open telemetry shared memory: " + name);
+    }
+
+    // the writer sizes the segment after creating it, mapping it before then would fault on the first read
+    if (!segment_is_big_enough(file_descriptor)) {
+        close(file_descriptor);
+        throw std::runtime_error("telemetry shared memory isn't set up yet: " + name);
+    }
+
+    void *mapping = mmap(nullptr, sizeof(WindowTelemetryBlock), PROT_READ, MAP_SHARED, file_descriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close(file_descriptor);
+        throw std::runtime_error("couldn't map telemetry shared memory: " + name);
+    }
+
+    block = static_cast<const WindowTelemetryBlock *>(mapping);
+
+    if (block->magic.load(std::memory_order_acquire) != window_telemetry_magic ||
+        block->version != window_telemetry_version) {
+        munmap(const_cast<WindowTelemetryBlock *>(block), sizeof(WindowTelemetryBlock));
+        close(file_descriptor);
+        throw std::runtime_error("telemetry shared memory has an unexpected layout: " + name);
+    }
+}
+
+WindowTelemetryReader::~WindowTelemetryReader() {
+    if (block)
+        munmap(const_cast<WindowTelemetryBlock *>(block), sizeof(WindowTelemetryBlock));
+    if (file_descriptor != -1)
+        close(file_descriptor);
+}
+
+#else
+
+WindowTelemetry::WindowTelemetry(const std::string &shared_memory_name, int refresh_rate_hz)
+    : shared_memory_name(normalize_shared_memory_name(shared_memory_name)) {
+    throw std::runtime_error("window telemetry is only supported on posix systems");
+}
+
+WindowTelemetry::~WindowTelemetry() {}
+
+WindowTelemetryReader::WindowTelemetryReader(const std::string &shared_memory_name) {
+    throw std::runtime_error("window telemetry is only supported on posix systems");
+}
+
+WindowTelemetryReader::~WindowTelemetryReader() {}
+
+#endif
+
+void WindowTelemetry::record_frame(double swap_duration_ms, double poll_duration_ms,
+                                   const WindowTelemetryWindowState &state) {
+    Clock::time_point now = Clock::now();
+
+    if (last_frame_end) {
+        double frame_time_ms = std::chrono::duration<double, std::milli>(now - *last_frame_end).count();
+        snapshot.last_frame_time_ms = frame_time_ms;
+
+        if (rolling_count == rolling_window_size) {
+            rolling_sum_ms -= rolling_frame_times_ms[rolling_next_index];
+        } else {
+            rolling_count++;
+        }
+        rolling_frame_times_ms[rolling_next_index] = frame_time_ms;
+        rolling_sum_ms += frame_time_ms;
+        rolling_next_index = (rolling_next_index + 1) % rolling_window_size;
+
+        snapshot.rolling_average_frame_time_ms = rolling_sum_ms / rolling_count;
+        snapshot.rolling_max_frame_time_ms =
+            *std::max_element(rolling_frame_times_ms.begin(), rolling_frame_times_ms.begin() + rolling_count);
+
+        if (snapshot.target_frame_time_ms > 0 &&
+            frame_time_ms > snapshot.target_frame_time_ms * dropped_frame_threshold) {
+            snapshot.dropped_frame_count++;
+        }
+    }
+    last_frame_end = now;
+
+    snapshot.frame_count++;
+    snapshot.last_swap_duration_ms = swap_duration_ms;
+    snapshot.last_poll_duration_ms = poll_duration_ms;
+    snapshot.window_width_px = state.window_width_px;
+    snapshot.window_height_px = state.window_height_px;
+    snapshot.framebuffer_width_px = state.framebuffer_width_px;
+    snapshot.framebuffer_height_px = state.framebuffer_height_px;
+    snapshot.window_in_fullscreen = state.window_in_fullscreen;
+    snapshot.cursor_is_disabled = state.cursor_is_disabled;
+
+    publish();
+}
+
+void WindowTelemetry::publish() {
+    if (!block)
+        return;
+
+    uint64_t sequence = block->sequence.load(std::memory_order_relaxed);
+    block->sequence.store(sequence + 1, std::memory_order_relaxed);
+    // keeps the payload writes from being moved above the odd sequence store
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&block->snapshot, &snapshot, sizeof(WindowTelemetrySnapshot));
+    block->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::optional<WindowTelemetrySnapshot> WindowTelemetryReader::read(unsigned int max_attempts) const {
+    if (!block)
+        return std::nullopt;
+
+    WindowTelemetrySnapshot copy;
+    for (unsigned int attempt = 0; attempt < max_attempts; ++attempt) {
+        uint64_t sequence_before = block->sequence.load(std::memory_order_acquire);
+        if (sequence_before & 1)
+            continue;
+
+        std::memcpy(&copy, &block->snapshot, sizeof(WindowTelemetrySnapshot));
+        // keeps the payload reads from being moved below the second sequence load
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        uint64_t sequence_after = block->sequence.load(std::memory_order_relaxed);
+        if (sequence_before == sequence_after)
+            return copy;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,145 @@
+#ifndef WINDOW_TELEMETRY_HPP
+#define WINDOW_TELEMETRY_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/*
+ * @note the telemetry block lives in a named shared memory segment so that an external monitor process can map it
+ * and read it at whatever rate it likes. the window is the only writer, readers never block it and it never waits on
+ * readers. consistency is provided by a seqlock: the writer makes the sequence odd while it is writing the payload and
+ * even once it is done, a reader copies the payload and retries if the sequence was odd or changed while copying.
+ *
+ * @note everything in here uses fixed size types so that a reader compiled separately sees the same layout.
+ */
+
+constexpr uint32_t window_telemetry_magic = 0x574e544d; // "WNTM"
+constexpr uint32_t window_telemetry_version = 2;
+
+struct WindowTelemetrySnapshot {
+    uint64_t frame_count = 0;
+    uint64_t dropped_frame_count = 0;
+
+    // a frame is measured from the end of one tick to the end of the next
+    double last_frame_time_ms = 0;
+    double rolling_average_frame_time_ms = 0;
+    double rolling_max_frame_time_ms = 0;
+    // frames that take longer than this times dropped_frame_threshold are counted as dropped
+    double target_frame_time_ms = 0;
+
+    double last_swap_duration_ms = 0;
+    double last_poll_duration_ms = 0;
+
+    uint32_t window_width_px = 0;
+    uint32_t window_height_px = 0;
+    uint32_t framebuffer_width_px = 0;
+    uint32_t framebuffer_height_px = 0;
+
+    uint32_t window_in_fullscreen = 0;
+    uint32_t cursor_is_disabled = 0;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock sequence is shared between processes so it has to be lock free");
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the magic is shared between processes so it has to be lock free");
+
+struct WindowTelemetryBlock {
+    // written last, so once it holds window_telemetry_magic the rest of the header is set up
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    // the process that created the segment, used to tell a stale segment from one that is still being written
+    int64_t owner_pid;
+    // odd while the writer is in the middle of an update
+    alignas(64) std::atomic<uint64_t> sequence;
+    WindowTelemetrySnapshot snapshot;
+};
+
+/// state that only the window knows about, gathered once per frame
+struct WindowTelemetryWindowState {
+    uint32_t window_width_px;
+    uint32_t window_height_px;
+    uint32_t framebuffer_width_px;
+    uint32_t framebuffer_height_px;
+    bool window_in_fullscreen;
+    bool cursor_is_disabled;
+};
+
+/*
+ * @brief the writing side of the telemetry block, owned by the window
+ *
+ * @note record_frame is the only thing called per frame, it does no syscalls and no allocation.
+ *
+ * @note names must be unique per machine. creating a telemetry block under a name that already exists throws, unless
+ * the existing block is fully set up and the process that created it is gone, in which case it is replaced.
+ */
+class WindowTelemetry {
+  public:
+    static constexpr double dropped_frame_threshold = 1.5;
+    static constexpr std::size_t rolling_window_size = 120;
+
+    /// @param shared_memory_name the name readers open, a leading '/' is added if it is missing
+    /// @param refresh_rate_hz used to decide which frames count as dropped, if zero nothing is counted as dropped
+    /// @throws std::runtime_error if the segment couldn't be created or the name is already in use
+    WindowTelemetry(const std::string &shared_memory_name, int refresh_rate_hz);
+    ~WindowTelemetry();
+
+    WindowTelemetry(const WindowTelemetry &) = delete;
+    WindowTelemetry &operator=(const WindowTelemetry &) = delete;
+
+    void record_frame(double swap_duration_ms, double poll_duration_ms, const WindowTelemetryWindowState &state);
+
+    const std::string &get_shared_memory_name() const { return shared_memory_name; }
+
+    /// shared memory names have to start with a '/', this adds it if it is missing
+    static std::string normalize_shared_memory_name(const std::string &name);
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string shared_memory_name;
+    int file_descriptor = -1;
+    WindowTelemetryBlock *block = nullptr;
+
+    // writer side copy, only ever published through the seqlock
+    WindowTelemetrySnapshot snapshot;
+    std::optional<Clock::time_point> last_frame_end;
+
+    std::array<double, rolling_window_size> rolling_frame_times_ms{};
+    std::size_t rolling_next_index = 0;
+    std::size_t rolling_count = 0;
+    double rolling_sum_ms = 0;
+
+    void publish();
+};
+
+/*
+ * @brief the reading side of the telemetry block, meant to be used by the external monitor process
+ *
+ * @note the segment is mapped read only, so a misbehaving monitor can never corrupt what the window writes.
+ */
+class WindowTelemetryReader {
+  public:
+    /// @throws std::runtime_error if the segment doesn't exist or isn't fully set up yet, in which case retrying
+    /// later is fine
+    explicit WindowTelemetryReader(const std::string &shared_memory_name);
+    ~WindowTelemetryReader();
+
+    WindowTelemetryReader(const WindowTelemetryReader &) = delete;
+    WindowTelemetryReader &operator=(const WindowTelemetryReader &) = delete;
+
+    /// returns nullopt if a consistent copy couldn't be taken within max_attempts, which only happens if the writer
+    /// is updating faster than we can copy
+    std::optional<WindowTelemetrySnapshot> read(unsigned int max_attempts = 64) const;
+
+  private:
+    int file_descriptor = -1;
+    const WindowTelemetryBlock *block = nullptr;
+};
+
+#endif // WINDOW_TELEMETRY_HPP